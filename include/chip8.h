@@ -3,20 +3,36 @@
 
 #include <string>
 #include <chrono>
+#include <cstdint>
+#include <memory>
 #include "constants.h"
-#include "beeper.h"
+#include "paged_memory.h"
+
+class Beeper;
 
 class Chip8 {
 public:
-    explicit Chip8(const Beeper &beeper);
+    // the beeper is not owned and may be null to run without sound,
+    // written memory pages come from the page allocator, the heap when null
+    explicit Chip8(const Beeper *beeper = nullptr, PageAllocator *pageAllocator = nullptr);
+
+    // seeds the random generator instead of reading std::random_device
+    Chip8(const Beeper *beeper, PageAllocator *pageAllocator, uint32_t seed);
 
     void loadRom(const std::string &path);
 
+    void loadRom(const std::shared_ptr<const RomImage> &rom);
+
     void execute();
 
     void decrementTimers();
 
-    const bool *getGraphics() const;
+    void tickTimers();
+
+    void seedRandom(uint32_t seed);
+
+    // one row per word, the most significant bit is the leftmost pixel
+    const uint64_t *getGraphics() const;
 
     uint8_t *getKeys();
 
@@ -26,12 +42,30 @@ public:
 
     void setShouldWaitForKeyPress(bool shouldWaitForKeyPress) { mShouldWaitForKeyPress = shouldWaitForKeyPress; }
 
+    const uint8_t *getRegisters() const { return V; }
+
+    const uint8_t *getMemoryPage(int index) const { return memory.getPage(index); }
+
+    size_t getFootprint() const { return sizeof(Chip8) + memory.getPrivatePageCount() * sizeof(Page); }
+
+    const uint16_t *getStack() const { return stack; }
+
+    uint16_t getI() const { return I; }
+
+    uint16_t getPC() const { return PC; }
+
+    uint8_t getSP() const { return SP; }
+
+    uint8_t getDT() const { return DT; }
+
+    uint8_t getST() const { return ST; }
+
 private:
-    Beeper mBeeper;
+    const Beeper *mBeeper;
 
     uint8_t V[REGISTER_SIZE]{};
-    uint8_t memory[MEMORY_SIZE]{};
-    bool graphics[GRAPHICS_WIDTH * GRAPHICS_HEIGHT]{};
+    PagedMemory memory;
+    uint64_t graphics[GRAPHICS_HEIGHT]{};
     uint16_t stack[STACK_SIZE]{};
     uint8_t keypad[KEY_SIZE]{}; // 0 if not pressed, non-0 if pressed
 
@@ -45,9 +79,11 @@ private:
 
     std::chrono::steady_clock::time_point mTimerPrev;
 
+    uint32_t mRandomState;
+
     uint16_t getCurrentOpcode();
 
-    static uint8_t randomByte();
+    uint8_t randomByte();
 
     void drawSprite(uint8_t x, uint8_t y, uint8_t n);
 };
@@ -0,0 +1,77 @@
+#ifndef C8_EMU_CHIP8_POOL_H
+#define C8_EMU_CHIP8_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <random>
+#include <type_traits>
+#include "chip8.h"
+#include "paged_memory.h"
+
+/*
+ * Hands out pages from a block reserved upfront, falling back to the heap once it runs out.
+ * Pages are only touched when handed out, so the untouched part of the block costs no resident memory.
+ */
+class PagePool : public PageAllocator {
+public:
+    explicit PagePool(size_t capacity);
+
+    PagePool(const PagePool &) = delete;
+
+    PagePool &operator=(const PagePool &) = delete;
+
+    Page *allocate() override;
+
+    void release(Page *page) override;
+
+    // pages that had to come from the heap because the block was exhausted, to size the pool
+    size_t getHeapFallbacks() const { return mHeapFallbacks.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<Page[]> mStorage;
+    size_t mCapacity;
+    size_t mUsed; // pages of the block handed out at least once
+    std::atomic<size_t> mHeapFallbacks;
+
+    std::vector<Page *> mFree;
+    std::mutex mMutex;
+
+    bool owns(const Page *page) const;
+};
+
+/*
+ * Recycles machines so that creating or destroying a session allocates nothing, every instance
+ * shares the rom image it is given and takes the pages it writes to from the pool.
+ * Sessions writing to more than pagesPerInstance pages on average make the page pool fall back
+ * to the heap, getPageHeapFallbacks tells when the pool should be sized up.
+ * All instances must be released before the pool is destroyed.
+ */
+class Chip8Pool {
+public:
+    explicit Chip8Pool(size_t capacity, size_t pagesPerInstance = 2);
+
+    Chip8Pool(const Chip8Pool &) = delete;
+
+    Chip8Pool &operator=(const Chip8Pool &) = delete;
+
+    Chip8 *acquire(const std::shared_ptr<const RomImage> &rom, const Beeper *beeper = nullptr);
+
+    void release(Chip8 *chip8);
+
+    size_t getPageHeapFallbacks() const { return mPages.getHeapFallbacks(); }
+
+private:
+    typedef std::aligned_storage<sizeof(Chip8), alignof(Chip8)>::type Slot;
+
+    PagePool mPages;
+
+    std::unique_ptr<Slot[]> mSlots;
+    std::vector<Chip8 *> mFree;
+    // seeds the instances, std::random_device is only read once for the pool
+    std::minstd_rand mSeeds;
+    std::mutex mMutex;
+};
+
+#endif //C8_EMU_CHIP8_POOL_H
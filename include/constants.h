@@ -12,6 +12,14 @@ const int GRAPHICS_WIDTH = 64;
 const int GRAPHICS_HEIGHT = 32;
 const bool DEBUG = false;
 
+// publish the framebuffer and registers to a POSIX shared memory region every frame (see shared_state.h)
+const bool SHARED_STATE_EXPORT = false;
+const char *const SHARED_STATE_NAME = "/c8-emu";
+
+// record every presented frame to a Y4M file from a background thread (see recorder.h)
+const bool RECORD_SESSION = false;
+const char *const RECORD_PATH = "c8-emu.y4m";
+
 const int FONT_SET_SIZE = 80;
 const uint8_t FONT_SET[FONT_SET_SIZE] = {
     0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
@@ -0,0 +1,86 @@
+#ifndef C8_EMU_PAGED_MEMORY_H
+#define C8_EMU_PAGED_MEMORY_H
+
+#include <string>
+#include <memory>
+#include <cstddef>
+#include "constants.h"
+
+const int PAGE_SIZE = 256;
+const int PAGE_COUNT = MEMORY_SIZE / PAGE_SIZE;
+
+struct Page {
+    uint8_t data[PAGE_SIZE];
+};
+
+class PageAllocator {
+public:
+    virtual ~PageAllocator() = default;
+
+    virtual Page *allocate() = 0;
+
+    virtual void release(Page *page) = 0;
+
+    static PageAllocator *heap();
+};
+
+// the font set and a rom laid out in memory, shared read-only by every machine running it
+class RomImage {
+public:
+    RomImage();
+
+    explicit RomImage(const std::string &path);
+
+    const Page *getPage(int index) const { return &mPages[index]; }
+
+    static const std::shared_ptr<const RomImage> &blank();
+
+private:
+    Page mPages[PAGE_COUNT]{};
+};
+
+/*
+ * Memory mapped page by page onto a rom image, a page is only copied into a private one
+ * taken from the allocator the first time it is written to.
+ */
+class PagedMemory {
+public:
+    explicit PagedMemory(PageAllocator *allocator = nullptr);
+
+    PagedMemory(const PagedMemory &other);
+
+    PagedMemory &operator=(const PagedMemory &other);
+
+    PagedMemory(PagedMemory &&other) noexcept;
+
+    PagedMemory &operator=(PagedMemory &&other) noexcept;
+
+    ~PagedMemory();
+
+    void map(const std::shared_ptr<const RomImage> &rom);
+
+    uint8_t read(uint16_t address) const { return mPages[address / PAGE_SIZE]->data[address % PAGE_SIZE]; }
+
+    void write(uint16_t address, uint8_t value);
+
+    const uint8_t *getPage(int index) const { return mPages[index]->data; }
+
+    size_t getPrivatePageCount() const;
+
+private:
+    PageAllocator *mAllocator;
+    std::shared_ptr<const RomImage> mRom;
+
+    const Page *mPages[PAGE_COUNT];
+    uint16_t mPrivatePages; // one bit per page copied from the allocator, clear while shared with the rom
+
+    bool isPrivate(int index) const { return (mPrivatePages >> index) & 0x1; }
+
+    void copyPrivatePages(const PagedMemory &other);
+
+    void takePrivatePages(PagedMemory &other);
+
+    void releasePrivatePages();
+};
+
+#endif //C8_EMU_PAGED_MEMORY_H
@@ -2,6 +2,7 @@
 #define C8_EMU_PLATFORM_H
 
 #include <string>
+#include <cstdint>
 #include <SDL.h>
 #include "constants.h"
 
@@ -17,7 +18,7 @@ public:
 
     void presentDisplay();
 
-    void drawGraphics(const bool *graphics);
+    void drawGraphics(const uint64_t *graphics);
 
 private:
     SDL_Window *mWindow;
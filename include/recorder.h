@@ -0,0 +1,61 @@
+#ifndef C8_EMU_RECORDER_H
+#define C8_EMU_RECORDER_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include "constants.h"
+
+const int RECORDER_QUEUE_SIZE = 64;
+
+/*
+ * Records presented frames to a Y4M (YUV4MPEG2) stream from a background thread.
+ * The emulation thread only copies the frame into a single-producer/single-consumer ring,
+ * when the ring is full the frame is dropped and the writer repeats the previous one in its place.
+ */
+class Recorder {
+public:
+    Recorder(const std::string &path, int fps);
+
+    ~Recorder();
+
+    Recorder(const Recorder &) = delete;
+
+    Recorder &operator=(const Recorder &) = delete;
+
+    void pushFrame(const uint64_t *graphics, uint8_t soundTimer);
+
+    uint64_t getDroppedFrames() const { return mDroppedFrames.load(std::memory_order_relaxed); }
+
+private:
+    struct Frame {
+        uint64_t index;
+        uint8_t soundTimer;
+        uint64_t graphics[GRAPHICS_HEIGHT];
+    };
+
+    std::ofstream mStream;
+
+    std::vector<Frame> mQueue;
+    std::atomic<size_t> mHead; // next slot to fill, owned by the emulation thread
+    std::atomic<size_t> mTail; // next slot to write, owned by the writer thread
+
+    uint64_t mFrameIndex;
+    std::atomic<uint64_t> mDroppedFrames;
+
+    std::atomic<bool> mRunning;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::thread mThread;
+
+    void run();
+
+    void writeFrame(const Frame &frame);
+};
+
+#endif //C8_EMU_RECORDER_H
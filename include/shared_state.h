@@ -0,0 +1,71 @@
+#ifndef C8_EMU_SHARED_STATE_H
+#define C8_EMU_SHARED_STATE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "constants.h"
+
+const uint32_t SHARED_STATE_MAGIC = 0x38433843; // "C8C8"
+const uint32_t SHARED_STATE_VERSION = 2;
+// attempts before a read gives up, the writer may have died in the middle of a publish
+const int SHARED_STATE_READ_RETRIES = 1000;
+
+struct SharedStatePayload {
+    uint64_t frame;
+
+    uint8_t V[REGISTER_SIZE];
+    uint16_t stack[STACK_SIZE];
+
+    uint16_t I;
+    uint16_t PC;
+    uint8_t SP;
+    uint8_t DT;
+    uint8_t ST;
+
+    // one row per word, the most significant bit is the leftmost pixel
+    uint64_t graphics[GRAPHICS_HEIGHT];
+};
+
+/*
+ * Layout of the shared memory region, guarded by a seqlock, readers only need this header.
+ * The writer makes the sequence odd before touching the payload and even again once done,
+ * so a reader mapping the region read-only has to retry whenever the sequence was odd
+ * or changed while it was reading.
+ */
+struct SharedState {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> sequence;
+
+    SharedStatePayload payload;
+
+    // false if no consistent snapshot could be taken within SHARED_STATE_READ_RETRIES attempts
+    bool read(SharedStatePayload &out) const;
+};
+
+// the region is shared between processes, so the sequence must work without a lock and the layout must be plain
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "the shared state sequence must be a lock free 32 bit atomic");
+static_assert(std::is_standard_layout<SharedState>::value, "the shared state must have a standard layout");
+
+inline bool SharedState::read(SharedStatePayload &out) const {
+    for (int attempt = 0; attempt < SHARED_STATE_READ_RETRIES; ++attempt) {
+        uint32_t begin = sequence.load(std::memory_order_acquire);
+        if (begin & 0x1) {
+            continue;
+        }
+
+        memcpy(&out, &payload, sizeof(payload));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sequence.load(std::memory_order_relaxed) == begin) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif //C8_EMU_SHARED_STATE_H
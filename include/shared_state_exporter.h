@@ -0,0 +1,27 @@
+#ifndef C8_EMU_SHARED_STATE_EXPORTER_H
+#define C8_EMU_SHARED_STATE_EXPORTER_H
+
+#include <string>
+#include <cstdint>
+#include "shared_state.h"
+#include "chip8.h"
+
+class SharedStateExporter {
+public:
+    explicit SharedStateExporter(const std::string &name);
+
+    ~SharedStateExporter();
+
+    SharedStateExporter(const SharedStateExporter &) = delete;
+
+    SharedStateExporter &operator=(const SharedStateExporter &) = delete;
+
+    void publish(const Chip8 &chip8, uint64_t frame);
+
+private:
+    std::string mName;
+    int mFd;
+    SharedState *mState;
+};
+
+#endif //C8_EMU_SHARED_STATE_EXPORTER_H
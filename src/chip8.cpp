@@ -1,35 +1,31 @@
 #include "chip8.h"
-#include <fstream>
+#include "beeper.h"
 #include <stdexcept>
 #include <random>
+#include <cstring>
 
 const long long TIMERS_TIME_PER_CYCLE = 1000 / 60;
 
-Chip8::Chip8(const Beeper &beeper) : mBeeper(beeper), I(0x000), PC(0x0200), SP(0x00), DT(0x00), ST(0x00),
-                                     mShouldWaitForKeyPress(false) {
-    for (int i = 0; i < FONT_SET_SIZE; i++) {
-        memory[i] = FONT_SET[i];
-    }
+static_assert(GRAPHICS_WIDTH == 64, "the framebuffer packs a row into a 64 bit word");
 
-    mTimerPrev = std::chrono::steady_clock::now();
+Chip8::Chip8(const Beeper *beeper, PageAllocator *pageAllocator)
+        : Chip8(beeper, pageAllocator, std::random_device{}()) {
 }
 
-void Chip8::loadRom(const std::string &path) {
-    // std::ios_base::ate to seek directly to the end to get the size
-    std::ifstream stream(path, std::ios_base::binary | std::ios_base::ate);
+Chip8::Chip8(const Beeper *beeper, PageAllocator *pageAllocator, uint32_t seed)
+        : mBeeper(beeper), memory(pageAllocator), I(0x000), PC(0x0200), SP(0x00), DT(0x00), ST(0x00),
+          mShouldWaitForKeyPress(false) {
+    mTimerPrev = std::chrono::steady_clock::now();
 
-    if (!stream.is_open()) {
-        throw std::runtime_error("could not open the file " + path);
-    }
+    seedRandom(seed);
+}
 
-    std::streampos size = stream.tellg();
-    if (size > MEMORY_SIZE - 0x200) {
-        throw std::runtime_error("the rom will not fit in memory");
-    }
+void Chip8::loadRom(const std::string &path) {
+    loadRom(std::make_shared<RomImage>(path));
+}
 
-    stream.seekg(std::ios_base::beg);
-    stream.read(reinterpret_cast<char *>(&memory[0x200]), size);
-    stream.close();
+void Chip8::loadRom(const std::shared_ptr<const RomImage> &rom) {
+    memory.map(rom);
 }
 
 void Chip8::execute() {
@@ -47,8 +43,11 @@ void Chip8::execute() {
     switch (opcodeFamily) {
         case 0x0:
             if (nnn == 0x0e0) { // CLS
-                memset(graphics, false, sizeof(graphics));
+                memset(graphics, 0, sizeof(graphics));
             } else if (nnn == 0x0ee) { // RET
+                if (SP == 0) {
+                    throw std::runtime_error("stack underflow");
+                }
                 PC = stack[--SP];
             }
             break;
@@ -57,6 +56,9 @@ void Chip8::execute() {
             incrementPC = false;
             break;
         case 0x2: // CALL addr
+            if (SP == STACK_SIZE) {
+                throw std::runtime_error("stack overflow");
+            }
             stack[SP++] = PC;
             PC = nnn;
             incrementPC = false;
@@ -137,7 +139,7 @@ void Chip8::execute() {
             drawSprite(x, y, n);
             break;
         case 0xe: {
-            uint8_t key = V[x];
+            uint8_t key = V[x] & 0x0f;
             if (nn == 0x9e) { // SKP Vx
                 if (keypad[key]) {
                     PC += 2;
@@ -167,17 +169,17 @@ void Chip8::execute() {
                 uint8_t tens = (V[x] / 10) % 10;
                 uint8_t ones = V[x] % 10;
 
-                memory[I & 0x0fff] = hundreds;
-                memory[(I + 1) & 0x0fff] = tens;
-                memory[(I + 2) & 0x0fff] = ones;
+                memory.write(I & 0x0fff, hundreds);
+                memory.write((I + 1) & 0x0fff, tens);
+                memory.write((I + 2) & 0x0fff, ones);
             } else if (nn == 0x55) { // LD [I], Vx
                 for (uint8_t i = 0; i <= x; i++) {
-                    memory[I & 0x0fff] = V[i];
+                    memory.write(I & 0x0fff, V[i]);
                     I = (I + 1) & 0x0fff;
                 }
             } else if (nn == 0x65) { // LD Vx, [I]
                 for (uint8_t i = 0; i <= x; i++) {
-                    V[i] = memory[I & 0x0fff];
+                    V[i] = memory.read(I & 0x0fff);
                     I = (I + 1) & 0x0fff;
                 }
             }
@@ -192,13 +194,16 @@ void Chip8::execute() {
 }
 
 uint16_t Chip8::getCurrentOpcode() {
-    return (memory[PC] << 8) | memory[PC + 1];
+    if (PC > MEMORY_SIZE - 2) {
+        throw std::runtime_error("program counter out of memory");
+    }
+    return (memory.read(PC) << 8) | memory.read(PC + 1);
 }
 
 void Chip8::setWaitedKeyPress() {
     // when doing wait key press, PC has already been incremented
     // should get the opcode of the previous execute
-    uint16_t previousOpcode = (memory[PC - 2] << 8) | memory[PC - 1];
+    uint16_t previousOpcode = (memory.read(PC - 2) << 8) | memory.read(PC - 1);
     uint8_t x = (previousOpcode & 0x0f00) >> 8;
 
     for (uint8_t i = 0; i < KEY_SIZE; ++i) {
@@ -219,22 +224,34 @@ void Chip8::decrementTimers() {
 
     if (timerElapsed >= TIMERS_TIME_PER_CYCLE) {
         mTimerPrev = timerCurr;
+        tickTimers();
+    }
+}
 
-        if (DT > 0) {
-            --DT;
-        }
+void Chip8::tickTimers() {
+    if (DT > 0) {
+        --DT;
+    }
 
-        if (ST > 0) {
-            --ST;
-            mBeeper.play();
+    if (ST > 0) {
+        --ST;
+        if (mBeeper != nullptr) {
+            mBeeper->play();
         }
     }
 }
 
+void Chip8::seedRandom(uint32_t seed) {
+    // xorshift gets stuck on a zero state
+    mRandomState = seed != 0 ? seed : 0x2545f491;
+}
+
 uint8_t Chip8::randomByte() {
-    std::mt19937 rng(std::random_device{}());
-    std::uniform_int_distribution<uint8_t> distribution(0x00, 0xff);
-    return distribution(rng);
+    // xorshift32, kept in the instance so copies of a machine replay the same sequence
+    mRandomState ^= mRandomState << 13;
+    mRandomState ^= mRandomState >> 17;
+    mRandomState ^= mRandomState << 5;
+    return mRandomState >> 24;
 }
 
 void Chip8::drawSprite(uint8_t x, uint8_t y, uint8_t n) {
@@ -243,38 +260,22 @@ void Chip8::drawSprite(uint8_t x, uint8_t y, uint8_t n) {
 
     V[0xf] = 0x0;
 
-    uint8_t i, j, sprite, spritePixel, mask, bits;
-    uint16_t index;
-    bool screenPixel;
-    for (i = 0; i < n; ++i) {
-        if (yPos + i > GRAPHICS_HEIGHT) {
-            continue;
-        }
-
-        sprite = memory[(I + i) & 0x0fff];
-
-        for (j = 0; j < 8; ++j) {
-            if (xPos + j > GRAPHICS_WIDTH) {
-                continue;
-            }
-
-            index = ((yPos + i) * GRAPHICS_WIDTH) + (xPos + j);
+    uint8_t i;
+    uint64_t row;
+    for (i = 0; i < n && yPos + i < GRAPHICS_HEIGHT; ++i) {
+        // move the sprite byte to the leftmost pixels then right to its column,
+        // the pixels past the right edge are shifted out
+        row = (static_cast<uint64_t>(memory.read((I + i) & 0x0fff)) << (GRAPHICS_WIDTH - 8)) >> xPos;
 
-            spritePixel = (sprite & (0x01 << (8 - j - 1))) >> (8 - j - 1);
-            screenPixel = graphics[index];
-
-            if (spritePixel == 0x1) {
-                if (screenPixel) {
-                    V[0xf] = 0x1;
-                }
-
-                graphics[index] = screenPixel ^ spritePixel;
-            }
+        if (graphics[yPos + i] & row) {
+            V[0xf] = 0x1;
         }
+
+        graphics[yPos + i] ^= row;
     }
 }
 
-const bool *Chip8::getGraphics() const {
+const uint64_t *Chip8::getGraphics() const {
     return graphics;
 }
 
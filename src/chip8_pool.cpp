@@ -0,0 +1,92 @@
+#include "chip8_pool.h"
+#include <stdexcept>
+#include <functional>
+#include <new>
+
+PagePool::PagePool(size_t capacity) : mStorage(new Page[capacity]), mCapacity(capacity), mUsed(0),
+                                      mHeapFallbacks(0) {
+    // reserved so that releasing never allocates
+    mFree.reserve(capacity);
+}
+
+Page *PagePool::allocate() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mFree.empty()) {
+            Page *page = mFree.back();
+            mFree.pop_back();
+            return page;
+        }
+
+        if (mUsed < mCapacity) {
+            return &mStorage[mUsed++];
+        }
+    }
+
+    mHeapFallbacks.fetch_add(1, std::memory_order_relaxed);
+    return new Page;
+}
+
+void PagePool::release(Page *page) {
+    if (!owns(page)) {
+        delete page;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFree.push_back(page);
+}
+
+bool PagePool::owns(const Page *page) const {
+    // heap pages are not part of the block, std::less gives a total order where < would be unspecified
+    const Page *begin = &mStorage[0];
+    const Page *end = begin + mCapacity;
+    return !std::less<const Page *>()(page, begin) && std::less<const Page *>()(page, end);
+}
+
+Chip8Pool::Chip8Pool(size_t capacity, size_t pagesPerInstance) : mPages(capacity * pagesPerInstance),
+                                                                 mSlots(new Slot[capacity]),
+                                                                 mSeeds(std::random_device{}()) {
+    mFree.reserve(capacity);
+    for (size_t i = capacity; i > 0; --i) {
+        mFree.push_back(reinterpret_cast<Chip8 *>(&mSlots[i - 1]));
+    }
+}
+
+Chip8 *Chip8Pool::acquire(const std::shared_ptr<const RomImage> &rom, const Beeper *beeper) {
+    if (!rom) {
+        throw std::runtime_error("an instance needs a rom image");
+    }
+
+    Chip8 *slot;
+    uint32_t seed;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mFree.empty()) {
+            throw std::runtime_error("no free instance left in the pool");
+        }
+        slot = mFree.back();
+        mFree.pop_back();
+        seed = static_cast<uint32_t>(mSeeds());
+    }
+
+    Chip8 *chip8;
+    try {
+        chip8 = new(slot) Chip8(beeper, &mPages, seed);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFree.push_back(slot);
+        throw;
+    }
+
+    chip8->loadRom(rom);
+    return chip8;
+}
+
+void Chip8Pool::release(Chip8 *chip8) {
+    // the destructor hands the written pages back to the page pool
+    chip8->~Chip8();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFree.push_back(chip8);
+}
@@ -2,9 +2,12 @@
 #include <stdexcept>
 #include <thread>
 #include <chrono>
+#include <memory>
 #include "chip8.h"
 #include "platform.h"
 #include "beeper.h"
+#include "shared_state_exporter.h"
+#include "recorder.h"
 
 const long long CLOCK_TIME = 1000 / 300;
 
@@ -14,9 +17,21 @@ int main() {
 
         Beeper beeper(440, 100);
 
-        Chip8 c8(beeper);
+        Chip8 c8(&beeper);
         c8.loadRom("roms/roms/demos/Maze (alt) [David Winter, 199x].ch8");
 
+        std::unique_ptr<SharedStateExporter> exporter;
+        if (SHARED_STATE_EXPORT) {
+            exporter.reset(new SharedStateExporter(SHARED_STATE_NAME));
+        }
+
+        std::unique_ptr<Recorder> recorder;
+        if (RECORD_SESSION) {
+            recorder.reset(new Recorder(RECORD_PATH, static_cast<int>(1000 / CLOCK_TIME)));
+        }
+
+        uint64_t frame = 0;
+
         std::chrono::steady_clock::time_point clockPrev = std::chrono::steady_clock::now();
         std::chrono::steady_clock::time_point clockCurr;
         long long clockDelta;
@@ -40,6 +55,14 @@ int main() {
 
             platform.presentDisplay();
 
+            if (exporter) {
+                exporter->publish(c8, frame);
+            }
+            if (recorder) {
+                recorder->pushFrame(c8.getGraphics(), c8.getST());
+            }
+            ++frame;
+
             clockCurr = std::chrono::steady_clock::now();
             clockDelta = std::chrono::duration_cast<std::chrono::milliseconds>(clockCurr - clockPrev).count();
 
@@ -0,0 +1,158 @@
+#include "paged_memory.h"
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+
+class HeapPageAllocator : public PageAllocator {
+public:
+    Page *allocate() override {
+        return new Page;
+    }
+
+    void release(Page *page) override {
+        delete page;
+    }
+};
+
+PageAllocator *PageAllocator::heap() {
+    static HeapPageAllocator allocator;
+    return &allocator;
+}
+
+RomImage::RomImage() {
+    for (int i = 0; i < FONT_SET_SIZE; i++) {
+        mPages[i / PAGE_SIZE].data[i % PAGE_SIZE] = FONT_SET[i];
+    }
+}
+
+RomImage::RomImage(const std::string &path) : RomImage() {
+    // std::ios_base::ate to seek directly to the end to get the size
+    std::ifstream stream(path, std::ios_base::binary | std::ios_base::ate);
+
+    if (!stream.is_open()) {
+        throw std::runtime_error("could not open the file " + path);
+    }
+
+    std::streampos size = stream.tellg();
+    if (size > MEMORY_SIZE - 0x200) {
+        throw std::runtime_error("the rom will not fit in memory");
+    }
+
+    stream.seekg(std::ios_base::beg);
+    // the rom starts on a page boundary, so it can be read page by page
+    int end = 0x200 + static_cast<int>(size);
+    for (int address = 0x200; address < end; address += PAGE_SIZE) {
+        std::streamsize count = std::min(PAGE_SIZE, end - address);
+        stream.read(reinterpret_cast<char *>(mPages[address / PAGE_SIZE].data), count);
+    }
+    stream.close();
+}
+
+const std::shared_ptr<const RomImage> &RomImage::blank() {
+    static const std::shared_ptr<const RomImage> image = std::make_shared<RomImage>();
+    return image;
+}
+
+static_assert(PAGE_COUNT <= 16, "the private pages are tracked in a 16 bit mask");
+
+PagedMemory::PagedMemory(PageAllocator *allocator)
+        : mAllocator(allocator != nullptr ? allocator : PageAllocator::heap()), mPrivatePages(0) {
+    map(RomImage::blank());
+}
+
+PagedMemory::PagedMemory(const PagedMemory &other)
+        : mAllocator(other.mAllocator), mRom(other.mRom), mPrivatePages(0) {
+    copyPrivatePages(other);
+}
+
+PagedMemory &PagedMemory::operator=(const PagedMemory &other) {
+    if (this != &other) {
+        releasePrivatePages();
+        mAllocator = other.mAllocator;
+        mRom = other.mRom;
+        copyPrivatePages(other);
+    }
+    return *this;
+}
+
+PagedMemory::PagedMemory(PagedMemory &&other) noexcept
+        : mAllocator(other.mAllocator), mRom(other.mRom), mPrivatePages(0) {
+    takePrivatePages(other);
+}
+
+PagedMemory &PagedMemory::operator=(PagedMemory &&other) noexcept {
+    if (this != &other) {
+        releasePrivatePages();
+        mAllocator = other.mAllocator;
+        mRom = other.mRom;
+        takePrivatePages(other);
+    }
+    return *this;
+}
+
+PagedMemory::~PagedMemory() {
+    releasePrivatePages();
+}
+
+void PagedMemory::map(const std::shared_ptr<const RomImage> &rom) {
+    releasePrivatePages();
+    mRom = rom;
+    for (int i = 0; i < PAGE_COUNT; ++i) {
+        mPages[i] = mRom->getPage(i);
+    }
+}
+
+void PagedMemory::write(uint16_t address, uint8_t value) {
+    int index = address / PAGE_SIZE;
+    if (!isPrivate(index)) {
+        Page *page = mAllocator->allocate();
+        *page = *mPages[index];
+        mPages[index] = page;
+        mPrivatePages |= 1 << index;
+    }
+    // private pages come from the allocator, only the rom pages are really const
+    const_cast<Page *>(mPages[index])->data[address % PAGE_SIZE] = value;
+}
+
+size_t PagedMemory::getPrivatePageCount() const {
+    size_t count = 0;
+    for (uint16_t mask = mPrivatePages; mask != 0; mask &= mask - 1) {
+        ++count;
+    }
+    return count;
+}
+
+void PagedMemory::copyPrivatePages(const PagedMemory &other) {
+    for (int i = 0; i < PAGE_COUNT; ++i) {
+        if (other.isPrivate(i)) {
+            Page *page = mAllocator->allocate();
+            *page = *other.mPages[i];
+            mPages[i] = page;
+        } else {
+            mPages[i] = mRom->getPage(i);
+        }
+    }
+    mPrivatePages = other.mPrivatePages;
+}
+
+void PagedMemory::takePrivatePages(PagedMemory &other) {
+    // the source is left mapped onto the bare rom, so it stays usable
+    for (int i = 0; i < PAGE_COUNT; ++i) {
+        mPages[i] = other.mPages[i];
+        if (other.isPrivate(i)) {
+            other.mPages[i] = mRom->getPage(i);
+        }
+    }
+    mPrivatePages = other.mPrivatePages;
+    other.mPrivatePages = 0;
+}
+
+void PagedMemory::releasePrivatePages() {
+    for (int i = 0; i < PAGE_COUNT; ++i) {
+        if (isPrivate(i)) {
+            mAllocator->release(const_cast<Page *>(mPages[i]));
+            mPages[i] = mRom->getPage(i);
+        }
+    }
+    mPrivatePages = 0;
+}
@@ -184,7 +184,7 @@ void Platform::presentDisplay() {
     SDL_RenderPresent(mRenderer);
 }
 
-void Platform::drawGraphics(const bool *graphics) {
+void Platform::drawGraphics(const uint64_t *graphics) {
     SDL_LockSurface(mSurface);
 
     int i, j, index;
@@ -192,7 +192,7 @@ void Platform::drawGraphics(const bool *graphics) {
     for (i = 0; i < GRAPHICS_WIDTH; ++i) {
         for (j = 0; j < GRAPHICS_HEIGHT; ++j) {
             index = (j * GRAPHICS_WIDTH) + i;
-            pixels[index] = graphics[index] ? mSetColor : mUnsetColor;
+            pixels[index] = (graphics[j] >> (GRAPHICS_WIDTH - 1 - i)) & 0x1 ? mSetColor : mUnsetColor;
         }
     }
 
@@ -0,0 +1,110 @@
+#include "recorder.h"
+#include <iostream>
+#include <stdexcept>
+#include <chrono>
+#include <cstring>
+
+// limited range luma, matching the black set / white unset pixels of the window
+const uint8_t LUMA_SET = 16;
+const uint8_t LUMA_UNSET = 235;
+
+Recorder::Recorder(const std::string &path, int fps) : mQueue(RECORDER_QUEUE_SIZE), mHead(0), mTail(0),
+                                                       mFrameIndex(0), mDroppedFrames(0), mRunning(true) {
+    mStream.open(path, std::ios_base::binary | std::ios_base::trunc);
+    if (!mStream.is_open()) {
+        throw std::runtime_error("could not open the file " + path);
+    }
+
+    mStream << "YUV4MPEG2 W" << GRAPHICS_WIDTH << " H" << GRAPHICS_HEIGHT << " F" << fps << ":1 Ip A1:1 Cmono\n";
+
+    mThread = std::thread(&Recorder::run, this);
+}
+
+Recorder::~Recorder() {
+    mRunning.store(false, std::memory_order_release);
+    mCondition.notify_one();
+    mThread.join();
+
+    mStream.close();
+
+    uint64_t dropped = getDroppedFrames();
+    if (dropped > 0) {
+        std::cout << "[warning]: recorder dropped " << dropped << " frames" << std::endl;
+    }
+}
+
+void Recorder::pushFrame(const uint64_t *graphics, uint8_t soundTimer) {
+    size_t head = mHead.load(std::memory_order_relaxed);
+    uint64_t index = mFrameIndex++;
+
+    if (head - mTail.load(std::memory_order_acquire) == mQueue.size()) {
+        mDroppedFrames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Frame &frame = mQueue[head % mQueue.size()];
+    frame.index = index;
+    frame.soundTimer = soundTimer;
+    memcpy(frame.graphics, graphics, sizeof(frame.graphics));
+
+    mHead.store(head + 1, std::memory_order_release);
+    mCondition.notify_one();
+}
+
+void Recorder::run() {
+    Frame previous{};
+    uint64_t nextIndex = 0;
+
+    while (true) {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+
+        if (tail == mHead.load(std::memory_order_acquire)) {
+            // frames pushed before stopping must still be written, so check the queue once more
+            if (!mRunning.load(std::memory_order_acquire)) {
+                if (tail == mHead.load(std::memory_order_acquire)) {
+                    break;
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait_for(lock, std::chrono::milliseconds(10));
+            continue;
+        }
+
+        const Frame &frame = mQueue[tail % mQueue.size()];
+
+        // coalesce the dropped frames into repeats of the previous one to keep the timing
+        for (; nextIndex < frame.index; ++nextIndex) {
+            writeFrame(previous);
+        }
+
+        writeFrame(frame);
+        nextIndex = frame.index + 1;
+        previous = frame;
+
+        mTail.store(tail + 1, std::memory_order_release);
+    }
+
+    // frames dropped after the last queued one, mFrameIndex is no longer written once stopped
+    for (; nextIndex < mFrameIndex; ++nextIndex) {
+        writeFrame(previous);
+    }
+
+    mStream.flush();
+}
+
+void Recorder::writeFrame(const Frame &frame) {
+    // the sound timer goes in an application specific frame parameter, which decoders ignore
+    mStream << "FRAME XST=" << static_cast<int>(frame.soundTimer) << "\n";
+
+    char luma[GRAPHICS_WIDTH * GRAPHICS_HEIGHT];
+    int i, j;
+    for (j = 0; j < GRAPHICS_HEIGHT; ++j) {
+        for (i = 0; i < GRAPHICS_WIDTH; ++i) {
+            bool set = (frame.graphics[j] >> (GRAPHICS_WIDTH - 1 - i)) & 0x1;
+            luma[(j * GRAPHICS_WIDTH) + i] = static_cast<char>(set ? LUMA_SET : LUMA_UNSET);
+        }
+    }
+    mStream.write(luma, sizeof(luma));
+}
@@ -0,0 +1,74 @@
+#include "shared_state_exporter.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+
+SharedStateExporter::SharedStateExporter(const std::string &name) : mName(name) {
+    mFd = shm_open(mName.c_str(), O_CREAT | O_RDWR, 0644);
+    if (mFd == -1) {
+        throw std::runtime_error("could not open shared memory " + mName + "! Error: " + strerror(errno));
+    }
+
+    // the kernel drops the lock when its owner dies, so a region left by a crashed emulator can be taken over
+    if (flock(mFd, LOCK_EX | LOCK_NB) == -1) {
+        int error = errno;
+        close(mFd);
+        if (error == EWOULDBLOCK) {
+            throw std::runtime_error("shared memory " + mName + " is already in use by another emulator");
+        }
+        throw std::runtime_error("could not lock shared memory " + mName + "! Error: " + strerror(error));
+    }
+
+    if (ftruncate(mFd, sizeof(SharedState)) == -1) {
+        std::string error = strerror(errno);
+        shm_unlink(mName.c_str());
+        close(mFd);
+        throw std::runtime_error("could not resize shared memory " + mName + "! Error: " + error);
+    }
+
+    void *address = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+    if (address == MAP_FAILED) {
+        std::string error = strerror(errno);
+        shm_unlink(mName.c_str());
+        close(mFd);
+        throw std::runtime_error("could not map shared memory " + mName + "! Error: " + error);
+    }
+
+    mState = new(address) SharedState();
+    mState->version = SHARED_STATE_VERSION;
+    mState->sequence.store(0, std::memory_order_relaxed);
+    // written last so readers polling for the magic only ever see an initialized region
+    std::atomic_thread_fence(std::memory_order_release);
+    mState->magic = SHARED_STATE_MAGIC;
+}
+
+SharedStateExporter::~SharedStateExporter() {
+    munmap(mState, sizeof(SharedState));
+    flock(mFd, LOCK_UN);
+    close(mFd);
+    shm_unlink(mName.c_str());
+}
+
+void SharedStateExporter::publish(const Chip8 &chip8, uint64_t frame) {
+    uint32_t sequence = mState->sequence.load(std::memory_order_relaxed);
+    mState->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    SharedStatePayload &payload = mState->payload;
+    payload.frame = frame;
+    memcpy(payload.V, chip8.getRegisters(), sizeof(payload.V));
+    memcpy(payload.stack, chip8.getStack(), sizeof(payload.stack));
+    payload.I = chip8.getI();
+    payload.PC = chip8.getPC();
+    payload.SP = chip8.getSP();
+    payload.DT = chip8.getDT();
+    payload.ST = chip8.getST();
+    memcpy(payload.graphics, chip8.getGraphics(), sizeof(payload.graphics));
+
+    mState->sequence.store(sequence + 2, std::memory_order_release);
+}
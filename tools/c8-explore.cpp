@@ -0,0 +1,515 @@
+/*
+ * Explores the input space of a rom by branching the machine state over every key each frame.
+ * States are deduplicated by a hash of the machine, the frontier is spread over worker threads
+ * that steal from each other when they run dry, and the run reports the instruction addresses
+ * reached and the states that no input can move forward anymore.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cctype>
+#include <sstream>
+#include <utility>
+#include "chip8.h"
+
+// the emulator runs 300 instructions per second against 60 timer ticks
+const int CYCLES_PER_FRAME = 5;
+const int SEEN_SHARDS = 64;
+const size_t MAX_REPORTED = 32;
+const uint8_t KEY_NONE = 0xff;
+
+struct ExplorerOptions {
+    std::string romPath;
+    unsigned threads = std::thread::hardware_concurrency();
+    unsigned maxFrames = 600;
+    size_t maxStates = 1000000;
+    size_t memoryMiB = 1024;
+};
+
+struct Node {
+    Chip8 chip8;
+    unsigned frame;
+    uint32_t trail; // index of the last step of the keys that reached this node
+};
+
+// one frame of input, chained back to the root through the parent steps
+struct TrailStep {
+    uint32_t parent;
+    uint8_t key;
+};
+
+struct StateReport {
+    uint64_t hash;
+    uint16_t PC;
+    unsigned frame;
+    std::string reason;
+    std::string keys;
+};
+
+class Explorer {
+public:
+    Explorer(const Chip8 &initial, const ExplorerOptions &options);
+
+    void run();
+
+    void printReport(std::ostream &out) const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Node> frontier;
+        std::vector<uint8_t> coverage;
+    };
+
+    struct SeenShard {
+        std::mutex mutex;
+        std::unordered_set<uint64_t> hashes;
+    };
+
+    const ExplorerOptions &mOptions;
+    size_t mMaxFrontierBytes;
+
+    std::vector<Worker> mWorkers;
+    SeenShard mSeen[SEEN_SHARDS];
+
+    // nodes queued or being expanded, the run is over once it drops to zero
+    std::atomic<size_t> mPending;
+    std::atomic<size_t> mFrontierBytes;
+    std::atomic<size_t> mStates;
+    std::atomic<size_t> mDuplicates;
+    std::atomic<size_t> mTruncated;
+
+    // only grows with the admitted states, so it stays within the state budget
+    std::deque<TrailStep> mTrail;
+    std::mutex mTrailMutex;
+
+    std::mutex mReportMutex;
+    std::vector<StateReport> mStuck;
+    std::vector<StateReport> mFaults;
+    size_t mStuckCount;
+    size_t mFaultCount;
+
+    std::vector<uint8_t> mCoverage;
+    double mElapsed;
+
+    void work(size_t id);
+
+    bool pop(size_t id, Node &node);
+
+    void push(size_t id, Chip8 chip8, unsigned frame, uint32_t trail);
+
+    void expand(size_t id, const Node &node);
+
+    bool markSeen(uint64_t hash);
+
+    uint32_t extendTrail(uint32_t parent, int key);
+
+    std::string describeKeys(uint32_t trail);
+
+    void report(std::vector<StateReport> &reports, size_t &count, StateReport state, uint32_t trail);
+
+    static void stepFrame(Chip8 &chip8, int key, std::vector<uint8_t> &coverage);
+
+    static uint64_t hashState(const Chip8 &chip8);
+
+    static void printState(std::ostream &out, const StateReport &state);
+};
+
+Explorer::Explorer(const Chip8 &initial, const ExplorerOptions &options)
+        : mOptions(options), mWorkers(options.threads), mPending(0), mFrontierBytes(0), mStates(0), mDuplicates(0),
+          mTruncated(0), mStuckCount(0), mFaultCount(0), mCoverage(MEMORY_SIZE, 0), mElapsed(0) {
+    if (options.memoryMiB > SIZE_MAX / (1024 * 1024)) {
+        throw std::runtime_error("the memory budget does not fit in the address space");
+    }
+    mMaxFrontierBytes = options.memoryMiB * 1024 * 1024;
+    if (mMaxFrontierBytes < sizeof(Node)) {
+        throw std::runtime_error("the memory budget cannot hold a single state");
+    }
+
+    for (Worker &worker: mWorkers) {
+        worker.coverage.assign(MEMORY_SIZE, 0);
+    }
+
+    // the root step stands for no input at all
+    mTrail.push_back(TrailStep{0, KEY_NONE});
+
+    markSeen(hashState(initial));
+    push(0, initial, 0, 0);
+}
+
+void Explorer::run() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+        threads.emplace_back(&Explorer::work, this, i);
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+
+    for (const Worker &worker: mWorkers) {
+        for (int i = 0; i < MEMORY_SIZE; ++i) {
+            mCoverage[i] |= worker.coverage[i];
+        }
+    }
+
+    mElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Explorer::work(size_t id) {
+    Node node;
+    while (true) {
+        if (pop(id, node)) {
+            expand(id, node);
+            mPending.fetch_sub(1, std::memory_order_acq_rel);
+            continue;
+        }
+
+        if (mPending.load(std::memory_order_acquire) == 0) {
+            break;
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+bool Explorer::pop(size_t id, Node &node) {
+    // the owner works depth first from the back to keep its frontier small
+    {
+        Worker &own = mWorkers[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.frontier.empty()) {
+            node = std::move(own.frontier.back());
+            own.frontier.pop_back();
+            mFrontierBytes.fetch_sub(node.chip8.getFootprint(), std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // thieves take the oldest, shallowest node, which tends to carry the largest subtree
+    for (size_t i = 1; i < mWorkers.size(); ++i) {
+        Worker &victim = mWorkers[(id + i) % mWorkers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.frontier.empty()) {
+            node = std::move(victim.frontier.front());
+            victim.frontier.pop_front();
+            mFrontierBytes.fetch_sub(node.chip8.getFootprint(), std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Explorer::push(size_t id, Chip8 chip8, unsigned frame, uint32_t trail) {
+    mPending.fetch_add(1, std::memory_order_acq_rel);
+    mFrontierBytes.fetch_add(chip8.getFootprint(), std::memory_order_relaxed);
+
+    Worker &own = mWorkers[id];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    own.frontier.push_back(Node{std::move(chip8), frame, trail});
+}
+
+void Explorer::expand(size_t id, const Node &node) {
+    uint64_t hash = hashState(node.chip8);
+    bool moved = false;
+    bool faulted = false;
+
+    // no key pressed, then each key on its own
+    for (int key = -1; key < KEY_SIZE; ++key) {
+        Chip8 next = node.chip8;
+
+        try {
+            stepFrame(next, key, mWorkers[id].coverage);
+        } catch (std::runtime_error &e) {
+            if (!faulted) {
+                // the keys include the frame that faulted
+                report(mFaults, mFaultCount, StateReport{hash, node.chip8.getPC(), node.frame, e.what(), ""},
+                       extendTrail(node.trail, key));
+                faulted = true;
+            }
+            moved = true;
+            continue;
+        }
+
+        uint64_t nextHash = hashState(next);
+        if (nextHash == hash) {
+            continue;
+        }
+        moved = true;
+
+        if (mStates.load(std::memory_order_relaxed) >= mOptions.maxStates) {
+            mTruncated.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (!markSeen(nextHash)) {
+            mDuplicates.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (node.frame + 1 >= mOptions.maxFrames ||
+            mFrontierBytes.load(std::memory_order_relaxed) + next.getFootprint() > mMaxFrontierBytes) {
+            mTruncated.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        push(id, std::move(next), node.frame + 1, extendTrail(node.trail, key));
+    }
+
+    if (!moved) {
+        report(mStuck, mStuckCount,
+               StateReport{hash, node.chip8.getPC(), node.frame, "no input makes progress", ""}, node.trail);
+    }
+}
+
+bool Explorer::markSeen(uint64_t hash) {
+    SeenShard &shard = mSeen[hash % SEEN_SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!shard.hashes.insert(hash).second) {
+        return false;
+    }
+
+    mStates.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+uint32_t Explorer::extendTrail(uint32_t parent, int key) {
+    std::lock_guard<std::mutex> lock(mTrailMutex);
+    mTrail.push_back(TrailStep{parent, key < 0 ? KEY_NONE : static_cast<uint8_t>(key)});
+    return static_cast<uint32_t>(mTrail.size() - 1);
+}
+
+std::string Explorer::describeKeys(uint32_t trail) {
+    std::vector<uint8_t> keys;
+    {
+        std::lock_guard<std::mutex> lock(mTrailMutex);
+        for (; trail != 0; trail = mTrail[trail].parent) {
+            keys.push_back(mTrail[trail].key);
+        }
+    }
+
+    // one key per frame from the start, "-" for no key, repeats as key*count
+    std::ostringstream out;
+    out << std::hex;
+    for (size_t i = keys.size(); i > 0;) {
+        uint8_t key = keys[i - 1];
+        size_t run = 0;
+        for (; i > 0 && keys[i - 1] == key; --i) {
+            ++run;
+        }
+
+        if (out.tellp() > 0) {
+            out << ' ';
+        }
+        if (key == KEY_NONE) {
+            out << '-';
+        } else {
+            out << static_cast<int>(key);
+        }
+        if (run > 1) {
+            out << '*' << std::dec << run << std::hex;
+        }
+    }
+    return out.str();
+}
+
+void Explorer::report(std::vector<StateReport> &reports, size_t &count, StateReport state, uint32_t trail) {
+    std::lock_guard<std::mutex> lock(mReportMutex);
+    ++count;
+    if (reports.size() < MAX_REPORTED) {
+        state.keys = describeKeys(trail);
+        reports.push_back(state);
+    }
+}
+
+void Explorer::stepFrame(Chip8 &chip8, int key, std::vector<uint8_t> &coverage) {
+    uint8_t *keys = chip8.getKeys();
+    memset(keys, 0, KEY_SIZE);
+    if (key >= 0) {
+        keys[key] = 1;
+    }
+
+    for (int i = 0; i < CYCLES_PER_FRAME; ++i) {
+        if (chip8.shouldWaitForKeyPress()) {
+            if (key < 0) {
+                break;
+            }
+            chip8.setShouldWaitForKeyPress(false);
+            chip8.setWaitedKeyPress();
+        }
+
+        // only counted once executed, a program counter outside memory faults instead
+        uint16_t PC = chip8.getPC();
+        chip8.execute();
+        coverage[PC] = 1;
+    }
+
+    chip8.tickTimers();
+}
+
+uint64_t Explorer::hashState(const Chip8 &chip8) {
+    // FNV-1a over the machine state, the random generator state is left out on purpose
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](const void *data, size_t size) {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ULL;
+        }
+    };
+
+    uint16_t I = chip8.getI(), PC = chip8.getPC();
+    uint8_t SP = chip8.getSP(), DT = chip8.getDT(), ST = chip8.getST();
+    bool waiting = chip8.shouldWaitForKeyPress();
+
+    mix(chip8.getRegisters(), REGISTER_SIZE);
+    for (int i = 0; i < PAGE_COUNT; ++i) {
+        mix(chip8.getMemoryPage(i), PAGE_SIZE);
+    }
+    mix(chip8.getGraphics(), GRAPHICS_HEIGHT * sizeof(uint64_t));
+    mix(chip8.getStack(), STACK_SIZE * sizeof(uint16_t));
+    mix(&I, sizeof(I));
+    mix(&PC, sizeof(PC));
+    mix(&SP, sizeof(SP));
+    mix(&DT, sizeof(DT));
+    mix(&ST, sizeof(ST));
+    mix(&waiting, sizeof(waiting));
+    return hash;
+}
+
+void Explorer::printReport(std::ostream &out) const {
+    out << "explored " << mStates.load() << " states in " << std::fixed << std::setprecision(2) << mElapsed
+        << "s (" << mDuplicates.load() << " duplicates, " << mTruncated.load() << " truncated)" << std::endl;
+
+    size_t reached = 0;
+    for (uint8_t covered: mCoverage) {
+        reached += covered;
+    }
+    out << "coverage: " << reached << " instruction addresses reached" << std::endl;
+
+    // consecutive instructions are 2 bytes apart, print them as ranges
+    out << std::hex << std::setfill('0');
+    for (int i = 0; i < MEMORY_SIZE; ++i) {
+        if (!mCoverage[i]) {
+            continue;
+        }
+        int end = i;
+        while (end + 2 < MEMORY_SIZE && mCoverage[end + 2]) {
+            end += 2;
+        }
+        out << "  0x" << std::setw(3) << i << "-0x" << std::setw(3) << end << std::endl;
+        i = end;
+    }
+    out << std::dec;
+
+    out << "stuck states: " << mStuckCount << std::endl;
+    for (const StateReport &state: mStuck) {
+        printState(out, state);
+    }
+
+    out << "faults: " << mFaultCount << std::endl;
+    for (const StateReport &state: mFaults) {
+        printState(out, state);
+    }
+}
+
+void Explorer::printState(std::ostream &out, const StateReport &state) {
+    out << "  frame " << state.frame << " PC 0x" << std::hex << std::setw(3) << state.PC << " hash 0x"
+        << std::setw(16) << state.hash << std::dec << ": " << state.reason << std::endl;
+    out << "    keys: " << (state.keys.empty() ? "(none)" : state.keys) << std::endl;
+}
+
+// a positive decimal count no larger than max
+static bool parseCount(const char *text, unsigned long long max, unsigned long long &value) {
+    if (!isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+
+    char *end;
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return *end == '\0' && errno != ERANGE && value > 0 && value <= max;
+}
+
+static bool parseOptions(int argc, char **argv, ExplorerOptions &options) {
+    unsigned long long value;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--threads" && hasValue) {
+            if (!parseCount(argv[++i], UINT_MAX, value)) {
+                return false;
+            }
+            options.threads = static_cast<unsigned>(value);
+        } else if (arg == "--frames" && hasValue) {
+            if (!parseCount(argv[++i], UINT_MAX, value)) {
+                return false;
+            }
+            options.maxFrames = static_cast<unsigned>(value);
+        } else if (arg == "--max-states" && hasValue) {
+            // trail steps are indexed with 32 bits
+            if (!parseCount(argv[++i], UINT32_MAX / 2, value)) {
+                return false;
+            }
+            options.maxStates = static_cast<size_t>(value);
+        } else if (arg == "--memory" && hasValue) {
+            if (!parseCount(argv[++i], SIZE_MAX / (1024 * 1024), value)) {
+                return false;
+            }
+            options.memoryMiB = static_cast<size_t>(value);
+        } else if (arg[0] != '-' && options.romPath.empty()) {
+            options.romPath = arg;
+        } else {
+            return false;
+        }
+    }
+
+    // hardware_concurrency is 0 when unknown
+    if (options.threads == 0) {
+        options.threads = 1;
+    }
+
+    return !options.romPath.empty();
+}
+
+int main(int argc, char **argv) {
+    ExplorerOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0]
+                  << " <rom> [--threads n] [--frames n] [--max-states n] [--memory MiB]" << std::endl;
+        return 1;
+    }
+
+    try {
+        Chip8 c8;
+        c8.seedRandom(1);
+        c8.loadRom(options.romPath);
+
+        Explorer explorer(c8, options);
+        explorer.run();
+        explorer.printReport(std::cout);
+
+        return 0;
+    } catch (std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
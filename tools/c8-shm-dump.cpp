@@ -0,0 +1,84 @@
+/*
+ * Prints the state an emulator publishes to shared memory, mapping the region read-only.
+ * Only depends on shared_state.h, as any other local reader would.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "shared_state.h"
+
+static void printPayload(const SharedStatePayload &payload, std::ostream &out) {
+    out << "frame " << payload.frame << std::endl;
+
+    out << std::hex << std::setfill('0');
+    out << "PC 0x" << std::setw(3) << payload.PC << "  I 0x" << std::setw(3) << payload.I
+        << "  SP 0x" << std::setw(2) << static_cast<int>(payload.SP)
+        << "  DT 0x" << std::setw(2) << static_cast<int>(payload.DT)
+        << "  ST 0x" << std::setw(2) << static_cast<int>(payload.ST) << std::endl;
+
+    for (int i = 0; i < REGISTER_SIZE; ++i) {
+        out << "V" << i << " 0x" << std::setw(2) << static_cast<int>(payload.V[i]) << (i % 8 == 7 ? "\n" : "  ");
+    }
+    out << std::dec;
+
+    int i, j;
+    for (j = 0; j < GRAPHICS_HEIGHT; ++j) {
+        for (i = 0; i < GRAPHICS_WIDTH; ++i) {
+            out << (((payload.graphics[j] >> (GRAPHICS_WIDTH - 1 - i)) & 0x1) ? '#' : '.');
+        }
+        out << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        std::cerr << "usage: " << argv[0] << " [name]" << std::endl;
+        return 1;
+    }
+    std::string name = argc == 2 ? argv[1] : SHARED_STATE_NAME;
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd == -1) {
+        std::cerr << "could not open shared memory " << name << "! Error: " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    // mapping past the end of a smaller region would fault on access
+    struct stat info{};
+    if (fstat(fd, &info) == -1 || info.st_size < static_cast<off_t>(sizeof(SharedState))) {
+        std::cerr << "shared memory " << name << " is too small to hold an emulator state" << std::endl;
+        close(fd);
+        return 1;
+    }
+
+    void *address = mmap(nullptr, sizeof(SharedState), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        std::cerr << "could not map shared memory " << name << "! Error: " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    const SharedState *state = static_cast<const SharedState *>(address);
+    SharedStatePayload payload;
+    int result = 1;
+
+    if (state->magic != SHARED_STATE_MAGIC || state->version != SHARED_STATE_VERSION) {
+        std::cerr << "shared memory " << name << " does not hold a version " << SHARED_STATE_VERSION
+                  << " emulator state" << std::endl;
+    } else if (!state->read(payload)) {
+        std::cerr << "could not read a consistent state, the emulator stopped in the middle of a frame" << std::endl;
+    } else {
+        printPayload(payload, std::cout);
+        result = 0;
+    }
+
+    munmap(address, sizeof(SharedState));
+    return result;
+}